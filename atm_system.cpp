@@ -5,23 +5,311 @@
 #include <stdexcept>
 #include <limits>
 #include <ctime>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <algorithm>
+#include <set>
+#include <deque>
+#include <unordered_map>
+#include <cstdint>
 
 using namespace std;
 
+#ifdef ATM_PROFILE
+// Phases of the transfer hot path timed when built with -DATM_PROFILE
+enum ProfilePhase {
+    PHASE_LOOKUP,
+    PHASE_VALIDATION,
+    PHASE_DETAILS,
+    PHASE_CONVERSION,
+    PHASE_WITHDRAW,
+    PHASE_DEPOSIT,
+    PHASE_HISTORY_APPEND,
+    PHASE_COUNT
+};
+
+// Aggregates time spent per phase, corrected for the cost of reading the clock
+class PhaseProfiler {
+private:
+    long long totalNanos[PHASE_COUNT];
+    long long lastNanos[PHASE_COUNT];
+    chrono::steady_clock::time_point lastStart[PHASE_COUNT];
+    long long samples[PHASE_COUNT];
+    long long clockOverhead;
+    
+    PhaseProfiler() : totalNanos(), lastNanos(), lastStart(), samples(), clockOverhead(0) {
+        const int rounds = 10000;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            chrono::steady_clock::now();
+        }
+        auto elapsed = chrono::steady_clock::now() - start;
+        clockOverhead = chrono::duration_cast<chrono::nanoseconds>(elapsed).count() / rounds;
+    }
+    
+public:
+    static PhaseProfiler& instance() {
+        static PhaseProfiler profiler;
+        return profiler;
+    }
+    
+    void record(ProfilePhase phase, chrono::steady_clock::time_point start, long long nanos) {
+        nanos -= clockOverhead;
+        if (nanos < 0) nanos = 0;
+        totalNanos[phase] += nanos;
+        lastNanos[phase] = nanos;
+        lastStart[phase] = start;
+        samples[phase]++;
+    }
+    
+    // Latest timing of each phase that started at or after `since`, for the slow
+    // operation log; phases not timed during the operation are left out
+    string phasesSince(chrono::steady_clock::time_point since) const {
+        static const char* const keys[PHASE_COUNT] = {
+            "lookup", "validation", "details", "fx", "withdraw", "deposit", "append"
+        };
+        string result;
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            if (samples[p] == 0 || lastStart[p] < since) continue;
+            if (!result.empty()) result += " ";
+            result += string(keys[p]) + "=" + to_string(lastNanos[p]) + "ns";
+        }
+        return result;
+    }
+    
+    // Print where the time of ATM::transfer went
+    void report() const {
+        static const char* const names[PHASE_COUNT] = {
+            "Lookup", "Validation", "Details string", "FX conversion", "Withdraw", "Deposit",
+            "History append*"
+        };
+        
+        long long transferTotal = 0;
+        for (int p = PHASE_LOOKUP; p <= PHASE_DEPOSIT; p++) {
+            transferTotal += totalNanos[p];
+        }
+        
+        cout << "\n========== TRANSFER PHASE PROFILE ==========\n";
+        cout << "Clock overhead: " << clockOverhead << " ns per reading (subtracted)\n";
+        cout << left << setw(18) << "Phase"
+             << setw(10) << "Samples"
+             << setw(14) << "Avg (ns)"
+             << "Share\n";
+        cout << string(50, '-') << endl;
+        
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            long long avg = samples[p] ? totalNanos[p] / samples[p] : 0;
+            cout << left << setw(18) << names[p]
+                 << setw(10) << samples[p]
+                 << setw(14) << avg;
+            if (p != PHASE_HISTORY_APPEND && transferTotal > 0) {
+                cout << fixed << setprecision(1) << (100.0 * totalNanos[p] / transferTotal) << "%";
+            }
+            cout << endl;
+        }
+        cout << "* nested in Withdraw/Deposit, counted for every account operation\n";
+        cout << "============================================\n";
+    }
+};
+
+// Charges the lifetime of the enclosing scope to a phase
+class PhaseTimer {
+private:
+    ProfilePhase phase;
+    chrono::steady_clock::time_point start;
+    
+public:
+    explicit PhaseTimer(ProfilePhase p) : phase(p), start(chrono::steady_clock::now()) {}
+    ~PhaseTimer() {
+        auto elapsed = chrono::steady_clock::now() - start;
+        PhaseProfiler::instance().record(phase, start, chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+    }
+};
+
+#define PROFILE_PHASE(phase) PhaseTimer phaseTimer_##phase(phase)
+#else
+#define PROFILE_PHASE(phase)
+#endif
+
+// Context captured for an operation that exceeded the latency threshold
+struct SlowOperation {
+    string timestamp;
+    string type;
+    string accounts;
+    size_t historyLength;
+    long long elapsedMicros;
+    string phases;
+};
+
+// Bounded buffer of slow operations, written out to a log file on flush
+class SlowOperationLog {
+private:
+    vector<SlowOperation> pending;
+    size_t capacity;
+    size_t dropped;
+    long long thresholdMicros;
+    string logPath;
+    
+public:
+    SlowOperationLog(long long threshold, size_t cap = 256, string path = "slow_operations.log")
+        : capacity(cap), dropped(0), thresholdMicros(threshold), logPath(path) {
+        pending.reserve(capacity);
+    }
+    
+    // Threshold comes from ATM_SLOW_OP_US, defaulting to one millisecond
+    static long long thresholdFromEnvironment() {
+        const char* value = getenv("ATM_SLOW_OP_US");
+        if (value != nullptr) {
+            long long parsed = atoll(value);
+            if (parsed > 0) return parsed;
+        }
+        return 1000;
+    }
+    
+    bool isSlow(long long elapsedMicros) const {
+        return elapsedMicros >= thresholdMicros;
+    }
+    
+    // Keep the entry if there is room; never grows past capacity
+    void capture(const SlowOperation& op) {
+        if (pending.size() >= capacity) {
+            dropped++;
+            return;
+        }
+        pending.push_back(op);
+    }
+    
+    // Append captured entries to the log file and empty the buffer
+    void flush() {
+        if (pending.empty() && dropped == 0) return;
+        
+        ofstream out(logPath, ios::app);
+        if (!out) return;
+        
+        for (const auto& op : pending) {
+            out << op.timestamp << " | " << op.type
+                << " | accounts=" << op.accounts
+                << " | history=" << op.historyLength
+                << " | elapsed=" << op.elapsedMicros << "us";
+            if (!op.phases.empty()) {
+                out << " | " << op.phases;
+            }
+            out << "\n";
+        }
+        if (dropped > 0) {
+            out << "(" << dropped << " slow operations dropped, buffer full)\n";
+        }
+        pending.clear();
+        dropped = 0;
+    }
+};
+
+// Readable local time without the trailing newline ctime adds
+string formatTimestamp(time_t t) {
+    string text = ctime(&t);
+    text.pop_back(); // Remove newline
+    return text;
+}
+
+// Mints unique, time-ordered 64-bit transaction IDs: seconds since the epoch in the
+// high bits, a sequence within that second in the low 20 bits
+class TransactionIdGenerator {
+private:
+    static const int SEQUENCE_BITS = 20;
+    
+public:
+    static uint64_t next() {
+        static uint64_t lastSecond = 0;
+        static uint64_t sequence = 0;
+        
+        uint64_t second = static_cast<uint64_t>(time(0));
+        // If the clock has not advanced (or stepped back), keep counting within
+        // lastSecond so IDs still increase; once that second's sequence is
+        // exhausted, borrow the next second
+        if (second > lastSecond) {
+            lastSecond = second;
+            sequence = 0;
+        } else if (++sequence >> SEQUENCE_BITS) {
+            lastSecond++;
+            sequence = 0;
+        }
+        return (lastSecond << SEQUENCE_BITS) | sequence;
+    }
+};
+
 // Transaction structure to store transaction details
 struct Transaction {
+    uint64_t id;
     string type;
     double amount;
     double balanceAfter;
+    time_t time;
     string timestamp;
     string details;
     
     Transaction(string t, double amt, double bal, string det = "") 
-        : type(t), amount(amt), balanceAfter(bal), details(det) {
-        time_t now = time(0);
-        timestamp = ctime(&now);
+        : id(TransactionIdGenerator::next()), type(t), amount(amt), balanceAfter(bal), details(det) {
+        time = ::time(0);
+        timestamp = ctime(&time);
         timestamp.pop_back(); // Remove newline
     }
+    
+    // Whether the entry took money out of the account
+    bool isDebit() const {
+        return type == "Withdrawal" || type == "Transfer Out" || type == "Hold Capture" ||
+               type == "Reversal Debit";
+    }
+};
+
+// Bucket key for a point in time, e.g. "%Y-%m-%d" for a day or "%Y-%m" for a month
+string periodKey(time_t t, const char* format) {
+    char buffer[16];
+    strftime(buffer, sizeof(buffer), format, localtime(&t));
+    return buffer;
+}
+
+// Last second of a calendar day in local time; day 0 means the last day of the previous month
+time_t endOfDay(int year, int month, int day) {
+    tm date = {};
+    date.tm_year = year - 1900;
+    date.tm_mon = month - 1;
+    date.tm_mday = day;
+    date.tm_hour = 23;
+    date.tm_min = 59;
+    date.tm_sec = 59;
+    date.tm_isdst = -1;
+    return mktime(&date);
+}
+
+// Parse "YYYY-MM-DD" into the last second of that day. Rejects trailing input and dates
+// that do not exist, which mktime would otherwise roll over (2026-02-31 -> March 3).
+bool parseEndOfDay(const string& text, time_t& result) {
+    int year, month, day;
+    char extra;
+    if (sscanf(text.c_str(), "%d-%d-%d%c", &year, &month, &day, &extra) != 3) {
+        return false;
+    }
+    
+    result = endOfDay(year, month, day);
+    if (result == static_cast<time_t>(-1)) {
+        return false;
+    }
+    const tm* normalized = localtime(&result);
+    return normalized->tm_year == year - 1900 && normalized->tm_mon == month - 1 &&
+           normalized->tm_mday == day;
+}
+
+// Running count and sum of one transaction type within a period
+struct TypeTotals {
+    int count;
+    double sum;
+    
+    TypeTotals() : count(0), sum(0.0) {}
 };
 
 // Custom exception classes
@@ -50,6 +338,91 @@ public:
     SameAccountException() : runtime_error("Cannot transfer to the same account") {}
 };
 
+class UnsupportedCurrencyException : public runtime_error {
+public:
+    UnsupportedCurrencyException() : runtime_error("Currency not supported") {}
+};
+
+class HoldNotFoundException : public runtime_error {
+public:
+    HoldNotFoundException() : runtime_error("Hold not found or already expired") {}
+};
+
+class TransactionNotFoundException : public runtime_error {
+public:
+    TransactionNotFoundException() : runtime_error("Transaction not found") {}
+};
+
+class ReversalNotAllowedException : public runtime_error {
+public:
+    ReversalNotAllowedException() : runtime_error("Transaction is a reversal or already reversed") {}
+};
+
+// An account's transfer legs with one counterparty, by transaction ID
+struct CounterpartyLegs {
+    vector<uint64_t> sent;
+    vector<uint64_t> received;
+};
+
+// Funds reserved on an account until captured, released or expired
+struct Hold {
+    int id;
+    double amount;
+    time_t expiresAt;
+    string details;
+};
+
+// Recurring transfer run automatically by the ATM when due
+struct StandingOrder {
+    int id;
+    string fromAccount;
+    string toAccount;
+    double amount;          // In the sender's currency
+    int intervalDays;
+    time_t nextRun;
+    
+    // Longest repeat interval or first-run delay, about ten years
+    static const int MAX_DAYS = 3660;
+    static const time_t SECONDS_PER_DAY = 24 * 60 * 60;
+};
+
+// Format an amount with its currency, e.g. "$12.50" or "EUR 12.50"
+string formatMoney(double amount, const string& currency) {
+    ostringstream out;
+    out << (currency == "USD" ? "$" : currency + " ") << fixed << setprecision(2) << amount;
+    return out.str();
+}
+
+// Exchange rates, stored as the USD value of one unit of each currency
+class ExchangeRates {
+private:
+    map<string, double> usdPerUnit;
+    
+public:
+    void setRate(const string& currency, double usdValue) {
+        if (usdValue <= 0) {
+            throw InvalidAmountException();
+        }
+        usdPerUnit[currency] = usdValue;
+    }
+    
+    bool supports(const string& currency) const {
+        return usdPerUnit.count(currency) > 0;
+    }
+    
+    // Convert an amount between two currencies through USD
+    double convert(double amount, const string& from, const string& to) const {
+        if (from == to) return amount;
+        
+        auto fromRate = usdPerUnit.find(from);
+        auto toRate = usdPerUnit.find(to);
+        if (fromRate == usdPerUnit.end() || toRate == usdPerUnit.end()) {
+            throw UnsupportedCurrencyException();
+        }
+        return amount * fromRate->second / toRate->second;
+    }
+};
+
 // Account class
 class Account {
 private:
@@ -57,16 +430,86 @@ private:
     string pin;
     string accountHolder;
     double balance;
+    double openingBalance;
+    string currency;
+    string bank;
     vector<Transaction> transactionHistory;
+    map<string, map<string, TypeTotals>> periodTotals;  // Day, month and "All" buckets -> type -> totals
+    vector<Hold> holds;
+    double heldAmount;      // Running total of holds, so available balance is one subtraction
+    time_t nextExpiry;      // Earliest hold expiry, lets expireHolds return early
+    int nextHoldId;
+    
+    // Append to history and fold the entry into its day, month and lifetime totals
+    void recordTransaction(const Transaction& trans) {
+        PROFILE_PHASE(PHASE_HISTORY_APPEND);
+        transactionHistory.push_back(trans);
+        
+        const string buckets[] = {
+            periodKey(trans.time, "%Y-%m-%d"), periodKey(trans.time, "%Y-%m"), "All"
+        };
+        for (const auto& bucket : buckets) {
+            TypeTotals& totals = periodTotals[bucket][trans.type];
+            totals.count++;
+            totals.sum += trans.amount;
+        }
+    }
+    
+    vector<Hold>::iterator findHold(int holdId) {
+        for (auto it = holds.begin(); it != holds.end(); ++it) {
+            if (it->id == holdId) {
+                return it;
+            }
+        }
+        throw HoldNotFoundException();
+    }
+    
+    vector<Hold>::iterator removeHold(vector<Hold>::iterator it) {
+        heldAmount -= it->amount;
+        auto next = holds.erase(it);
+        if (holds.empty()) {
+            heldAmount = 0.0; // Drop accumulated rounding error
+        }
+        return next;
+    }
     
 public:
-    Account(string accNum, string p, string holder, double initialBalance = 0.0) 
-        : accountNumber(accNum), pin(p), accountHolder(holder), balance(initialBalance) {}
+    Account(string accNum, string p, string holder, double initialBalance = 0.0, string curr = "USD",
+            string bankName = "Alpha Bank") 
+        : accountNumber(accNum), pin(p), accountHolder(holder), balance(initialBalance),
+          openingBalance(initialBalance), currency(curr), bank(bankName),
+          heldAmount(0.0), nextExpiry(numeric_limits<time_t>::max()), nextHoldId(1) {}
     
     // Getters
     string getAccountNumber() const { return accountNumber; }
     string getAccountHolder() const { return accountHolder; }
     double getBalance() const { return balance; }
+    string getCurrency() const { return currency; }
+    string getBank() const { return bank; }
+    double getHeldAmount() const { return heldAmount; }
+    double getAvailableBalance() const { return balance - heldAmount; }
+    const vector<Hold>& getHolds() const { return holds; }
+    
+    // Balance as of a point in time. History is appended in time order and every entry
+    // records balanceAfter, so this is a binary search rather than a replay.
+    double balanceAt(time_t when) const {
+        auto after = upper_bound(transactionHistory.begin(), transactionHistory.end(), when,
+                                 [](time_t t, const Transaction& trans) { return t < trans.time; });
+        if (after == transactionHistory.begin()) {
+            return openingBalance;
+        }
+        return (after - 1)->balanceAfter;
+    }
+    
+    // Totals by transaction type for a day ("YYYY-MM-DD"), month ("YYYY-MM") or "All"
+    const map<string, TypeTotals>& getTotals(const string& period) const {
+        static const map<string, TypeTotals> none;
+        auto it = periodTotals.find(period);
+        return it == periodTotals.end() ? none : it->second;
+    }
+    size_t getHistoryLength() const { return transactionHistory.size(); }
+    const Transaction& getLastTransaction() const { return transactionHistory.back(); }
+    const Transaction& getTransaction(size_t position) const { return transactionHistory.at(position); }
     
     // Verify PIN
     bool verifyPin(const string& inputPin) const {
@@ -74,24 +517,82 @@ public:
     }
     
     // Deposit money
-    void deposit(double amount, string details = "") {
+    void deposit(double amount, string details = "", string type = "Deposit") {
         if (amount <= 0) {
             throw InvalidAmountException();
         }
         balance += amount;
-        transactionHistory.push_back(Transaction("Deposit", amount, balance, details));
+        recordTransaction(Transaction(type, amount, balance, details));
     }
     
     // Withdraw money
-    void withdraw(double amount, string details = "") {
+    void withdraw(double amount, string details = "", string type = "Withdrawal") {
         if (amount <= 0) {
             throw InvalidAmountException();
         }
-        if (amount > balance) {
+        expireHolds(time(0));
+        if (amount > getAvailableBalance()) {
             throw InsufficientFundsException();
         }
         balance -= amount;
-        transactionHistory.push_back(Transaction("Withdrawal", amount, balance, details));
+        recordTransaction(Transaction(type, amount, balance, details));
+    }
+    
+    // Drop holds whose expiry has passed; returns how many expired
+    int expireHolds(time_t now) {
+        if (now < nextExpiry) return 0;
+        
+        int expired = 0;
+        nextExpiry = numeric_limits<time_t>::max();
+        for (auto it = holds.begin(); it != holds.end(); ) {
+            if (it->expiresAt <= now) {
+                it = removeHold(it);
+                expired++;
+            } else {
+                nextExpiry = min(nextExpiry, it->expiresAt);
+                ++it;
+            }
+        }
+        return expired;
+    }
+    
+    // Longest a hold may stay open: 30 days
+    static const int MAX_HOLD_MINUTES = 30 * 24 * 60;
+    
+    // Reserve funds without posting a transaction; returns the hold id
+    int placeHold(double amount, int minutes, string details = "") {
+        if (amount <= 0 || minutes <= 0 || minutes > MAX_HOLD_MINUTES) {
+            throw InvalidAmountException();
+        }
+        time_t now = time(0);
+        expireHolds(now);
+        if (amount > getAvailableBalance()) {
+            throw InsufficientFundsException();
+        }
+        
+        Hold hold{nextHoldId++, amount, now + static_cast<time_t>(minutes) * 60, details};
+        holds.push_back(hold);
+        heldAmount += amount;
+        nextExpiry = min(nextExpiry, hold.expiresAt);
+        return hold.id;
+    }
+    
+    // Post a held amount as a debit and free the reservation
+    void captureHold(int holdId) {
+        expireHolds(time(0));
+        auto it = findHold(holdId);
+        double amount = it->amount;
+        string details = "Hold #" + to_string(holdId) + (it->details.empty() ? "" : ": " + it->details);
+        removeHold(it);
+        
+        balance -= amount;
+        recordTransaction(Transaction("Hold Capture", amount, balance, details));
+    }
+    
+    // Give a held amount back to the available balance
+    void releaseHold(int holdId) {
+        expireHolds(time(0));
+        removeHold(findHold(holdId));
     }
     
     // Display transaction history
@@ -102,30 +603,257 @@ public:
         }
         
         cout << "\n========== TRANSACTION HISTORY ==========\n";
-        cout << left << setw(15) << "Type" 
+        cout << left << setw(17) << "Type" 
              << setw(15) << "Amount" 
              << setw(15) << "Balance" 
              << "Details\n";
         cout << string(70, '-') << endl;
         
         for (const auto& trans : transactionHistory) {
-            cout << left << setw(15) << trans.type
-                 << "$" << setw(14) << fixed << setprecision(2) << trans.amount
-                 << "$" << setw(14) << trans.balanceAfter;
+            cout << left << setw(17) << trans.type
+                 << setw(15) << formatMoney(trans.amount, currency)
+                 << setw(15) << formatMoney(trans.balanceAfter, currency);
             if (!trans.details.empty()) {
                 cout << trans.details;
             }
-            cout << "\n" << string(45, ' ') << trans.timestamp << endl;
+            cout << "\n" << string(47, ' ') << trans.timestamp << "  #" << trans.id << endl;
         }
         cout << "=========================================\n";
     }
 };
 
+// Live top-K rankings kept up to date as transactions are posted, so queries never scan accounts.
+// Balances and flows are compared in USD.
+class Leaderboards {
+private:
+    // One posted entry inside the activity window
+    struct Activity {
+        time_t time;
+        string accountNumber;
+        double outflow;     // Negative for money coming in
+    };
+    
+    static const time_t WINDOW_SECONDS = 60 * 60;
+    
+    map<string, double> balances;
+    set<pair<double, string>> byBalance;
+    
+    deque<Activity> window;
+    map<string, pair<int, double>> windowTotals;    // Account -> (entries, net outflow)
+    set<pair<int, string>> byActivity;
+    set<pair<double, string>> byOutflow;
+    
+    // Move an account's window totals by a delta, keeping both rankings in step
+    void adjustWindow(const string& accNum, int countDelta, double outflowDelta) {
+        pair<int, double>& totals = windowTotals[accNum];
+        byActivity.erase(make_pair(totals.first, accNum));
+        byOutflow.erase(make_pair(totals.second, accNum));
+        
+        totals.first += countDelta;
+        totals.second += outflowDelta;
+        if (totals.first == 0) {
+            windowTotals.erase(accNum);
+            return;
+        }
+        byActivity.insert(make_pair(totals.first, accNum));
+        byOutflow.insert(make_pair(totals.second, accNum));
+    }
+    
+    template <typename T>
+    static vector<pair<T, string>> top(const set<pair<T, string>>& ranking, size_t k) {
+        vector<pair<T, string>> result;
+        for (auto it = ranking.rbegin(); it != ranking.rend() && result.size() < k; ++it) {
+            result.push_back(*it);
+        }
+        return result;
+    }
+    
+public:
+    void updateBalance(const string& accNum, double usdBalance) {
+        auto it = balances.find(accNum);
+        if (it != balances.end()) {
+            byBalance.erase(make_pair(it->second, accNum));
+        }
+        balances[accNum] = usdBalance;
+        byBalance.insert(make_pair(usdBalance, accNum));
+    }
+    
+    void recordActivity(const string& accNum, time_t when, double usdOutflow) {
+        window.push_back(Activity{when, accNum, usdOutflow});
+        adjustWindow(accNum, 1, usdOutflow);
+    }
+    
+    // Drop activity older than the window
+    void expire(time_t now) {
+        while (!window.empty() && window.front().time <= now - WINDOW_SECONDS) {
+            adjustWindow(window.front().accountNumber, -1, -window.front().outflow);
+            window.pop_front();
+        }
+    }
+    
+    vector<pair<double, string>> topBalances(size_t k) const { return top(byBalance, k); }
+    vector<pair<int, string>> mostActive(size_t k) const { return top(byActivity, k); }
+    vector<pair<double, string>> largestOutflows(size_t k) const { return top(byOutflow, k); }
+};
+
+// Directed money-flow graph between accounts in compressed sparse row form:
+// the out-edges of node i are targets[offsets[i] .. offsets[i + 1])
+class TransferGraph {
+private:
+    vector<string> nodes;
+    vector<size_t> offsets;
+    vector<size_t> targets;
+    vector<size_t> inDegrees;
+    
+    size_t findRoot(vector<size_t>& parent, size_t node) const {
+        while (parent[node] != node) {
+            parent[node] = parent[parent[node]];
+            node = parent[node];
+        }
+        return node;
+    }
+    
+    void findCycles(size_t start, size_t node, vector<size_t>& path, size_t maxLength,
+                    vector<vector<string>>& cycles) const {
+        for (size_t e = offsets[node]; e < offsets[node + 1]; e++) {
+            size_t next = targets[e];
+            if (next == start && path.size() >= 2) {
+                vector<string> cycle;
+                for (size_t n : path) cycle.push_back(nodes[n]);
+                cycles.push_back(cycle);
+            } else if (next > start && path.size() < maxLength &&
+                       find(path.begin(), path.end(), next) == path.end()) {
+                // Only extend through nodes after the start so each cycle is reported once
+                path.push_back(next);
+                findCycles(start, next, path, maxLength, cycles);
+                path.pop_back();
+            }
+        }
+    }
+    
+public:
+    // Edges are (source, target) node indexes and must be sorted by source
+    TransferGraph(const vector<string>& nodeNames, const vector<pair<size_t, size_t>>& edges)
+        : nodes(nodeNames), offsets(nodeNames.size() + 1, 0), inDegrees(nodeNames.size(), 0) {
+        targets.reserve(edges.size());
+        for (const auto& edge : edges) {
+            offsets[edge.first + 1]++;
+            inDegrees[edge.second]++;
+            targets.push_back(edge.second);
+        }
+        for (size_t i = 0; i < nodes.size(); i++) {
+            offsets[i + 1] += offsets[i];
+        }
+    }
+    
+    size_t nodeCount() const { return nodes.size(); }
+    size_t edgeCount() const { return targets.size(); }
+    const string& node(size_t i) const { return nodes[i]; }
+    size_t outDegree(size_t i) const { return offsets[i + 1] - offsets[i]; }
+    size_t inDegree(size_t i) const { return inDegrees[i]; }
+    
+    // Weakly connected groups of two or more accounts
+    vector<vector<string>> components() const {
+        vector<size_t> parent(nodes.size());
+        for (size_t i = 0; i < nodes.size(); i++) parent[i] = i;
+        for (size_t i = 0; i < nodes.size(); i++) {
+            for (size_t e = offsets[i]; e < offsets[i + 1]; e++) {
+                parent[findRoot(parent, i)] = findRoot(parent, targets[e]);
+            }
+        }
+        
+        map<size_t, vector<string>> groups;
+        for (size_t i = 0; i < nodes.size(); i++) {
+            groups[findRoot(parent, i)].push_back(nodes[i]);
+        }
+        vector<vector<string>> result;
+        for (const auto& group : groups) {
+            if (group.second.size() >= 2) result.push_back(group.second);
+        }
+        return result;
+    }
+    
+    // Simple cycles of 2 to maxLength accounts, each reported once from its lowest node
+    vector<vector<string>> cycles(size_t maxLength) const {
+        vector<vector<string>> result;
+        vector<size_t> path;
+        for (size_t start = 0; start < nodes.size(); start++) {
+            path.assign(1, start);
+            findCycles(start, start, path, maxLength, result);
+        }
+        return result;
+    }
+};
+
+// One side of a journal posting; every posting has a debit leg and an equal credit leg
+struct JournalLeg {
+    uint64_t transactionId;
+    string ledgerAccount;   // A customer account number or an internal ledger such as "ATM Cash"
+    double debit;           // USD
+    double credit;          // USD
+};
+
+// Append-only double-entry journal with an index of each ledger account's legs
+class Journal {
+private:
+    vector<JournalLeg> legs;
+    map<string, vector<size_t>> postingsByLedger;
+    
+    void append(const JournalLeg& leg) {
+        postingsByLedger[leg.ledgerAccount].push_back(legs.size());
+        legs.push_back(leg);
+    }
+    
+public:
+    // Record a balanced posting: debit one ledger account, credit another
+    void post(uint64_t transactionId, const string& debitLedger, const string& creditLedger, double amount) {
+        append(JournalLeg{transactionId, debitLedger, amount, 0.0});
+        append(JournalLeg{transactionId, creditLedger, 0.0, amount});
+    }
+    
+    size_t size() const { return legs.size(); }
+    
+    // Total debits and credits per ledger account, read through the posting index
+    map<string, pair<double, double>> trialBalance() const {
+        map<string, pair<double, double>> totals;
+        for (const auto& ledger : postingsByLedger) {
+            pair<double, double>& sums = totals[ledger.first];
+            for (size_t position : ledger.second) {
+                sums.first += legs[position].debit;
+                sums.second += legs[position].credit;
+            }
+        }
+        return totals;
+    }
+};
+
+// Net position a bank settled at end of day; positive means it received funds
+struct SettlementEntry {
+    time_t time;
+    string bank;
+    double netPosition;     // USD
+};
+
 // ATM class
 class ATM {
 private:
     vector<Account> accounts;
     Account* currentAccount;
+    SlowOperationLog slowLog;
+    ExchangeRates rates;
+    string localCurrency;
+    string operatorPin;
+    vector<StandingOrder> standingOrders;
+    time_t nextStandingOrderRun;    // Earliest nextRun, lets the scheduler return early
+    int nextStandingOrderId;
+    Leaderboards leaderboards;
+    map<pair<string, string>, double> interbankObligations;  // (payer bank, payee bank) -> USD owed
+    vector<SettlementEntry> settlements;
+    Journal journal;
+    unordered_map<uint64_t, pair<Account*, size_t>> transactionIndex;  // ID -> (account, history position)
+    unordered_map<uint64_t, uint64_t> transferLegs;                     // Each transfer leg -> its other leg
+    set<uint64_t> reversedIds;
+    map<pair<string, string>, CounterpartyLegs> counterpartyIndex;    // (account, counterparty) -> legs
     
     void clearInputBuffer() {
         cin.clear();
@@ -138,18 +866,273 @@ private:
                 return &acc;
             }
         }
-        return nullptr;
+        return nullptr;
+    }
+    
+    // Capture an operation in the slow log if it took longer than the threshold
+    void recordIfSlow(const string& type, const string& accountList, size_t historyLength,
+                      chrono::steady_clock::time_point start) {
+        auto elapsed = chrono::steady_clock::now() - start;
+        long long micros = chrono::duration_cast<chrono::microseconds>(elapsed).count();
+        if (!slowLog.isSlow(micros)) return;
+        
+        string phases;
+#ifdef ATM_PROFILE
+        phases = PhaseProfiler::instance().phasesSince(start);
+#endif
+        slowLog.capture(SlowOperation{formatTimestamp(time(0)), type, accountList, historyLength, micros, phases});
+    }
+    
+    // The internal ledger on the other side of a customer entry of this type
+    static string contraLedgerFor(const string& type) {
+        if (type == "Deposit" || type == "Withdrawal") return "ATM Cash";
+        if (type == "Hold Capture") return "Card Settlement";
+        return "Transfer Suspense";
+    }
+    
+    // Fold an account's newest history entry into the indexes and live rankings, and
+    // post it to the journal: customer accounts are liabilities, so a credit raises
+    // the balance and a debit lowers it. Reversals pass the contra ledger of the
+    // entry they undo.
+    void onPosted(Account& acc, const string& contraLedger = "") {
+        const Transaction& trans = acc.getLastTransaction();
+        transactionIndex[trans.id] = make_pair(&acc, acc.getHistoryLength() - 1);
+        double usdAmount = rates.convert(trans.amount, acc.getCurrency(), "USD");
+        
+        string contra = contraLedger.empty() ? contraLedgerFor(trans.type) : contraLedger;
+        if (trans.isDebit()) {
+            journal.post(trans.id, acc.getAccountNumber(), contra, usdAmount);
+        } else {
+            journal.post(trans.id, contra, acc.getAccountNumber(), usdAmount);
+        }
+
+        leaderboards.expire(trans.time);
+        leaderboards.recordActivity(acc.getAccountNumber(), trans.time, trans.isDebit() ? usdAmount : -usdAmount);
+        leaderboards.updateBalance(acc.getAccountNumber(), rates.convert(acc.getBalance(), acc.getCurrency(), "USD"));
+    }
+    
+    // A transfer between customers of different banks leaves the payer's bank owing the payee's
+    void recordObligation(const Account& payer, const Account& payee, double amount) {
+        if (payer.getBank() == payee.getBank()) return;
+        interbankObligations[make_pair(payer.getBank(), payee.getBank())] += 
+            rates.convert(amount, payer.getCurrency(), "USD");
+    }
+    
+    // Pay several recipients from one account, all or nothing. Every leg is checked
+    // (amount, recipient, currency) and the legs are debited against a running copy of
+    // the balance, with the same comparison withdraw makes, before any money moves.
+    // Should a leg still fail, the legs already posted are reversed.
+    void executeSplitTransfer(Account& sender, const vector<pair<Account*, double>>& legs) {
+        sender.expireHolds(time(0));
+        double balanceAfter = sender.getBalance();
+        for (const auto& leg : legs) {
+            if (leg.second <= 0) {
+                throw InvalidAmountException();
+            }
+            if (leg.first->getAccountNumber() == sender.getAccountNumber()) {
+                throw SameAccountException();
+            }
+            if (!rates.supports(sender.getCurrency()) || !rates.supports(leg.first->getCurrency())) {
+                throw UnsupportedCurrencyException();
+            }
+            if (rates.convert(leg.second, sender.getCurrency(), leg.first->getCurrency()) <= 0) {
+                throw InvalidAmountException();
+            }
+            if (leg.second > balanceAfter - sender.getHeldAmount()) {
+                throw InsufficientFundsException();
+            }
+            balanceAfter -= leg.second;
+        }
+        
+        vector<uint64_t> posted;
+        try {
+            for (const auto& leg : legs) {
+                executeTransfer(sender, *leg.first, leg.second);
+                posted.push_back(sender.getLastTransaction().id);
+            }
+        } catch (const runtime_error&) {
+            for (auto it = posted.rbegin(); it != posted.rend(); ++it) {
+                reverseTransaction(*it);
+            }
+            throw;
+        }
+    }
+    
+    const Transaction& lookupTransaction(uint64_t id, Account*& owner) {
+        auto it = transactionIndex.find(id);
+        if (it == transactionIndex.end()) {
+            throw TransactionNotFoundException();
+        }
+        owner = it->second.first;
+        return owner->getTransaction(it->second.second);
+    }
+    
+    // Post compensating entries for a transaction; a transfer is reversed on both legs.
+    // Debits are taken first so a failure leaves every balance untouched.
+    void reverseTransaction(uint64_t id) {
+        Account* owner;
+        Transaction original = lookupTransaction(id, owner);
+        if (original.type.compare(0, 8, "Reversal") == 0 || reversedIds.count(id)) {
+            throw ReversalNotAllowedException();
+        }
+        
+        vector<pair<Account*, Transaction>> legs;
+        legs.push_back(make_pair(owner, original));
+        auto peer = transferLegs.find(id);
+        if (peer != transferLegs.end()) {
+            Account* peerOwner;
+            Transaction peerLeg = lookupTransaction(peer->second, peerOwner);
+            legs.push_back(make_pair(peerOwner, peerLeg));
+        }
+        
+        // The credited side has to be debited back, which is the step that can fail
+        if (legs.size() == 2 && legs[0].second.isDebit()) {
+            swap(legs[0], legs[1]);
+        }
+        
+        for (const auto& leg : legs) {
+            Account& acc = *leg.first;
+            const Transaction& trans = leg.second;
+            string details = "Reversal of #" + to_string(trans.id);
+            if (trans.isDebit()) {
+                acc.deposit(trans.amount, details, "Reversal Credit");
+            } else {
+                acc.withdraw(trans.amount, details, "Reversal Debit");
+            }
+            onPosted(acc, contraLedgerFor(trans.type));
+            reversedIds.insert(trans.id);
+        }
+        
+        // Money now flows back from the recipient's bank to the sender's
+        if (legs.size() == 2) {
+            recordObligation(*legs[0].first, *legs[1].first, legs[0].second.amount);
+        }
+    }
+    
+    // Every counterparty an account has transferred with; keys for one account are contiguous
+    vector<pair<string, const CounterpartyLegs*>> counterpartiesOf(const string& accNum) const {
+        vector<pair<string, const CounterpartyLegs*>> result;
+        for (auto it = counterpartyIndex.lower_bound(make_pair(accNum, string()));
+             it != counterpartyIndex.end() && it->first.first == accNum; ++it) {
+            result.push_back(make_pair(it->first.second, &it->second));
+        }
+        return result;
+    }
+    
+    // Transfer legs on accNum's side with one counterparty, oldest first
+    vector<uint64_t> transfersBetween(const string& accNum, const string& counterparty) const {
+        vector<uint64_t> result;
+        auto it = counterpartyIndex.find(make_pair(accNum, counterparty));
+        if (it == counterpartyIndex.end()) return result;
+        
+        // IDs are time-ordered, so merging the two lists gives posting order
+        const CounterpartyLegs& legs = it->second;
+        result.resize(legs.sent.size() + legs.received.size());
+        merge(legs.sent.begin(), legs.sent.end(), legs.received.begin(), legs.received.end(), result.begin());
+        return result;
+    }
+    
+    // Note recorded on a converted entry, e.g. "Converted from $100.00"
+    string conversionNote(double amount, const string& from, const string& to) const {
+        if (from == to) return "";
+        return "Converted from " + formatMoney(amount, from);
+    }
+    
+    // Move money between two validated accounts; amount is in the sender's currency.
+    // Returns the amount credited in the recipient's currency.
+    double executeTransfer(Account& sender, Account& recipient, double amount) {
+        auto start = chrono::steady_clock::now();
+        string senderDetails, recipientDetails;
+        {
+            PROFILE_PHASE(PHASE_DETAILS);
+            senderDetails = "Transfer to " + recipient.getAccountHolder() + 
+                            " (Acc: " + recipient.getAccountNumber() + ")";
+            recipientDetails = "Transfer from " + sender.getAccountHolder() + 
+                               " (Acc: " + sender.getAccountNumber() + ")";
+        }
+        
+        double credited;
+        {
+            PROFILE_PHASE(PHASE_CONVERSION);
+            credited = rates.convert(amount, sender.getCurrency(), recipient.getCurrency());
+            // Checked before the debit so nothing can fail between withdraw and deposit
+            if (credited <= 0) {
+                throw InvalidAmountException();
+            }
+            if (sender.getCurrency() != recipient.getCurrency()) {
+                recipientDetails += ", " + conversionNote(amount, sender.getCurrency(), recipient.getCurrency());
+            }
+        }
+        
+        {
+            PROFILE_PHASE(PHASE_WITHDRAW);
+            sender.withdraw(amount, senderDetails, "Transfer Out");
+        }
+        {
+            PROFILE_PHASE(PHASE_DEPOSIT);
+            recipient.deposit(credited, recipientDetails, "Transfer In");
+        }
+        onPosted(sender);
+        onPosted(recipient);
+        
+        uint64_t outId = sender.getLastTransaction().id;
+        uint64_t inId = recipient.getLastTransaction().id;
+        transferLegs[outId] = inId;
+        transferLegs[inId] = outId;
+        counterpartyIndex[make_pair(sender.getAccountNumber(), recipient.getAccountNumber())].sent.push_back(outId);
+        counterpartyIndex[make_pair(recipient.getAccountNumber(), sender.getAccountNumber())].received.push_back(inId);
+        recordObligation(sender, recipient, amount);
+        
+        recordIfSlow("Transfer", sender.getAccountNumber() + "->" + recipient.getAccountNumber(),
+                     sender.getHistoryLength(), start);
+        return credited;
     }
     
 public:
-    ATM() : currentAccount(nullptr) {
+    ATM() : currentAccount(nullptr), slowLog(SlowOperationLog::thresholdFromEnvironment()),
+            localCurrency("USD"), nextStandingOrderRun(numeric_limits<time_t>::max()),
+            nextStandingOrderId(1) {
+        rates.setRate("USD", 1.0);
+        rates.setRate("EUR", 1.08);
+        rates.setRate("GBP", 1.27);
+        rates.setRate("NGN", 0.00065);
+        
+        // The terminal's cash currency comes from ATM_LOCAL_CURRENCY, defaulting to USD
+        const char* terminalCurrency = getenv("ATM_LOCAL_CURRENCY");
+        if (terminalCurrency != nullptr) {
+            if (rates.supports(terminalCurrency)) {
+                localCurrency = terminalCurrency;
+            } else {
+                cout << "Warning: ATM_LOCAL_CURRENCY " << terminalCurrency 
+                     << " is not supported, using " << localCurrency << ".\n";
+            }
+        }
+        
+        // Operator reports stay locked unless ATM_OPERATOR_PIN is set
+        const char* configuredOperatorPin = getenv("ATM_OPERATOR_PIN");
+        if (configuredOperatorPin != nullptr) {
+            operatorPin = configuredOperatorPin;
+        }
+        
         // Pre-load some accounts for testing
         accounts.push_back(Account("1001", "1234", "Ehindero Henry", 5000000.0));
         accounts.push_back(Account("1002", "5678", "Juria Momoh", 3000.0));
         accounts.push_back(Account("1003", "9999", "Stephen", 10000.0));
-        accounts.push_back(Account("1004", "3829", "Ajao Michael", 100.0));
-        accounts.push_back(Account("1005", "4783", "Deji", 10000.0));
-        accounts.push_back(Account("1006", "2378", "Omotola", 0.0));
+        accounts.push_back(Account("1004", "3829", "Ajao Michael", 100.0, "USD", "Beta Bank"));
+        accounts.push_back(Account("1005", "4783", "Deji", 10000.0, "EUR", "Gamma Bank"));
+        accounts.push_back(Account("1006", "2378", "Omotola", 0.0, "NGN", "Beta Bank"));
+        
+        for (const auto& acc : accounts) {
+            double usdBalance = rates.convert(acc.getBalance(), acc.getCurrency(), "USD");
+            leaderboards.updateBalance(acc.getAccountNumber(), usdBalance);
+            if (usdBalance > 0) {
+                journal.post(TransactionIdGenerator::next(), "Opening Equity", acc.getAccountNumber(), usdBalance);
+            }
+        }
+    }
+    
+    ~ATM() {
+        slowLog.flush();
     }
     
     // User authentication
@@ -184,8 +1167,19 @@ public:
         cout << "\n========== BALANCE INQUIRY ==========\n";
         cout << "Account Holder: " << currentAccount->getAccountHolder() << endl;
         cout << "Account Number: " << currentAccount->getAccountNumber() << endl;
-        cout << "Current Balance: $" << fixed << setprecision(2) 
-             << currentAccount->getBalance() << endl;
+        cout << "Current Balance: " 
+             << formatMoney(currentAccount->getBalance(), currentAccount->getCurrency()) << endl;
+        currentAccount->expireHolds(time(0));
+        if (currentAccount->getHeldAmount() > 0) {
+            cout << "On Hold: " 
+                 << formatMoney(currentAccount->getHeldAmount(), currentAccount->getCurrency()) << endl;
+            cout << "Available Balance: " 
+                 << formatMoney(currentAccount->getAvailableBalance(), currentAccount->getCurrency()) << endl;
+        }
+        if (currentAccount->getCurrency() != localCurrency) {
+            double local = rates.convert(currentAccount->getBalance(), currentAccount->getCurrency(), localCurrency);
+            cout << "Approx. in " << localCurrency << ": " << formatMoney(local, localCurrency) << endl;
+        }
         cout << "=====================================\n";
     }
     
@@ -195,7 +1189,7 @@ public:
         
         double amount;
         cout << "\n========== DEPOSIT ==========\n";
-        cout << "Enter deposit amount: $";
+        cout << "Enter deposit amount (" << localCurrency << "): ";
         
         if (!(cin >> amount)) {
             clearInputBuffer();
@@ -204,12 +1198,21 @@ public:
         }
         
         try {
-            currentAccount->deposit(amount);
+            // Cash is taken in the terminal's currency and credited in the account's
+            auto start = chrono::steady_clock::now();
+            const string& accountCurrency = currentAccount->getCurrency();
+            double credited = rates.convert(amount, localCurrency, accountCurrency);
+            currentAccount->deposit(credited, conversionNote(amount, localCurrency, accountCurrency));
+            onPosted(*currentAccount);
+            recordIfSlow("Deposit", currentAccount->getAccountNumber(),
+                         currentAccount->getHistoryLength(), start);
             cout << "\nDeposit successful!\n";
-            cout << "New Balance: $" << fixed << setprecision(2) 
-                 << currentAccount->getBalance() << endl;
+            cout << "New Balance: " 
+                 << formatMoney(currentAccount->getBalance(), accountCurrency) << endl;
         } catch (const InvalidAmountException& e) {
             cout << "\nError: " << e.what() << endl;
+        } catch (const UnsupportedCurrencyException& e) {
+            cout << "\nError: " << e.what() << endl;
         }
     }
     
@@ -219,9 +1222,9 @@ public:
         
         double amount;
         cout << "\n========== WITHDRAWAL ==========\n";
-        cout << "Current Balance: $" << fixed << setprecision(2) 
-             << currentAccount->getBalance() << endl;
-        cout << "Enter withdrawal amount: $";
+        cout << "Current Balance: " 
+             << formatMoney(currentAccount->getBalance(), currentAccount->getCurrency()) << endl;
+        cout << "Enter withdrawal amount (" << localCurrency << "): ";
         
         if (!(cin >> amount)) {
             clearInputBuffer();
@@ -230,14 +1233,23 @@ public:
         }
         
         try {
-            currentAccount->withdraw(amount);
+            // Cash is dispensed in the terminal's currency and debited in the account's
+            auto start = chrono::steady_clock::now();
+            const string& accountCurrency = currentAccount->getCurrency();
+            double debited = rates.convert(amount, localCurrency, accountCurrency);
+            currentAccount->withdraw(debited, conversionNote(amount, localCurrency, accountCurrency));
+            onPosted(*currentAccount);
+            recordIfSlow("Withdrawal", currentAccount->getAccountNumber(),
+                         currentAccount->getHistoryLength(), start);
             cout << "\nWithdrawal successful!\n";
-            cout << "New Balance: $" << fixed << setprecision(2) 
-                 << currentAccount->getBalance() << endl;
+            cout << "New Balance: " 
+                 << formatMoney(currentAccount->getBalance(), accountCurrency) << endl;
         } catch (const InsufficientFundsException& e) {
             cout << "\nError: " << e.what() << endl;
         } catch (const InvalidAmountException& e) {
             cout << "\nError: " << e.what() << endl;
+        } catch (const UnsupportedCurrencyException& e) {
+            cout << "\nError: " << e.what() << endl;
         }
     }
     
@@ -250,25 +1262,33 @@ public:
         double amount;
         
         cout << "\n========== TRANSFER MONEY ==========\n";
-        cout << "Current Balance: $" << fixed << setprecision(2) 
-             << currentAccount->getBalance() << endl;
+        cout << "Current Balance: " 
+             << formatMoney(currentAccount->getBalance(), currentAccount->getCurrency()) << endl;
         cout << "Enter recipient account number: ";
         cin >> recipientAccNum;
         
         try {
             // Check if recipient account exists
-            Account* recipientAccount = findAccount(recipientAccNum);
-            if (recipientAccount == nullptr) {
-                throw AccountNotFoundException();
+            Account* recipientAccount;
+            {
+                PROFILE_PHASE(PHASE_LOOKUP);
+                recipientAccount = findAccount(recipientAccNum);
             }
             
-            // Check if trying to transfer to same account
-            if (recipientAccount->getAccountNumber() == currentAccount->getAccountNumber()) {
-                throw SameAccountException();
+            {
+                PROFILE_PHASE(PHASE_VALIDATION);
+                if (recipientAccount == nullptr) {
+                    throw AccountNotFoundException();
+                }
+                
+                // Check if trying to transfer to same account
+                if (recipientAccount->getAccountNumber() == currentAccount->getAccountNumber()) {
+                    throw SameAccountException();
+                }
             }
             
             cout << "Recipient: " << recipientAccount->getAccountHolder() << endl;
-            cout << "Enter transfer amount: $";
+            cout << "Enter transfer amount (" << currentAccount->getCurrency() << "): ";
             
             if (!(cin >> amount)) {
                 clearInputBuffer();
@@ -277,18 +1297,17 @@ public:
             }
             
             // Perform the transfer
-            string senderDetails = "Transfer to " + recipientAccount->getAccountHolder() + 
-                                 " (Acc: " + recipientAccount->getAccountNumber() + ")";
-            string recipientDetails = "Transfer from " + currentAccount->getAccountHolder() + 
-                                    " (Acc: " + currentAccount->getAccountNumber() + ")";
-            
-            currentAccount->withdraw(amount, senderDetails);
-            recipientAccount->deposit(amount, recipientDetails);
+            double credited = executeTransfer(*currentAccount, *recipientAccount, amount);
             
             cout << "\n========== TRANSFER SUCCESSFUL ==========\n";
-            cout << "Transferred: $" << fixed << setprecision(2) << amount << endl;
+            cout << "Transferred: " << formatMoney(amount, currentAccount->getCurrency()) << endl;
             cout << "To: " << recipientAccount->getAccountHolder() << endl;
-            cout << "Your New Balance: $" << currentAccount->getBalance() << endl;
+            if (recipientAccount->getCurrency() != currentAccount->getCurrency()) {
+                cout << "Recipient Receives: " 
+                     << formatMoney(credited, recipientAccount->getCurrency()) << endl;
+            }
+            cout << "Your New Balance: " 
+                 << formatMoney(currentAccount->getBalance(), currentAccount->getCurrency()) << endl;
             cout << "=========================================\n";
             
         } catch (const AccountNotFoundException& e) {
@@ -299,6 +1318,8 @@ public:
             cout << "\nError: " << e.what() << endl;
         } catch (const InvalidAmountException& e) {
             cout << "\nError: " << e.what() << endl;
+        } catch (const UnsupportedCurrencyException& e) {
+            cout << "\nError: " << e.what() << endl;
         }
     }
     
@@ -308,18 +1329,413 @@ public:
         currentAccount->displayTransactionHistory();
     }
     
+    // Place, capture and release card pre-authorization holds
+    void manageHolds() {
+        if (currentAccount == nullptr) return;
+        
+        const string& currency = currentAccount->getCurrency();
+        currentAccount->expireHolds(time(0));
+        
+        cout << "\n========== CARD HOLDS ==========\n";
+        if (currentAccount->getHolds().empty()) {
+            cout << "No active holds.\n";
+        } else {
+            cout << left << setw(6) << "ID" << setw(18) << "Amount" << setw(27) << "Expires" << "Details\n";
+            cout << string(70, '-') << endl;
+            for (const auto& hold : currentAccount->getHolds()) {
+                cout << left << setw(6) << hold.id
+                     << setw(18) << formatMoney(hold.amount, currency)
+                     << setw(27) << formatTimestamp(hold.expiresAt)
+                     << hold.details << endl;
+            }
+        }
+        cout << "Available Balance: " << formatMoney(currentAccount->getAvailableBalance(), currency) << endl;
+        cout << "1. Place Hold\n";
+        cout << "2. Capture Hold\n";
+        cout << "3. Release Hold\n";
+        cout << "4. Back\n";
+        cout << "Enter your choice: ";
+        
+        int choice;
+        if (!(cin >> choice)) {
+            clearInputBuffer();
+            cout << "Invalid input! Please enter a number.\n";
+            return;
+        }
+        
+        try {
+            if (choice == 1) {
+                double amount;
+                int minutes;
+                string merchant;
+                cout << "Enter hold amount (" << currency << "): ";
+                if (!(cin >> amount)) {
+                    clearInputBuffer();
+                    cout << "Error: Invalid input. Please enter a valid number.\n";
+                    return;
+                }
+                cout << "Expires in (minutes, up to " << Account::MAX_HOLD_MINUTES << "): ";
+                if (!(cin >> minutes)) {
+                    clearInputBuffer();
+                    cout << "Error: Invalid input. Please enter a valid number.\n";
+                    return;
+                }
+                cout << "Merchant: ";
+                cin >> merchant;
+                int holdId = currentAccount->placeHold(amount, minutes, merchant);
+                cout << "\nHold #" << holdId << " placed for " << formatMoney(amount, currency) << endl;
+            } else if (choice == 2 || choice == 3) {
+                int holdId;
+                cout << "Enter hold ID: ";
+                if (!(cin >> holdId)) {
+                    clearInputBuffer();
+                    cout << "Error: Invalid input. Please enter a valid number.\n";
+                    return;
+                }
+                if (choice == 2) {
+                    currentAccount->captureHold(holdId);
+                    onPosted(*currentAccount);
+                    cout << "\nHold #" << holdId << " captured.\n";
+                } else {
+                    currentAccount->releaseHold(holdId);
+                    cout << "\nHold #" << holdId << " released.\n";
+                }
+                cout << "Available Balance: " 
+                     << formatMoney(currentAccount->getAvailableBalance(), currency) << endl;
+            }
+        } catch (const InsufficientFundsException& e) {
+            cout << "\nError: " << e.what() << endl;
+        } catch (const InvalidAmountException& e) {
+            cout << "\nError: " << e.what() << endl;
+        } catch (const HoldNotFoundException& e) {
+            cout << "\nError: " << e.what() << endl;
+        }
+    }
+    
+    // Execute every standing order run due by now, catching up on runs missed while down.
+    // Every run goes to standing_orders.log; only the logged-in customer's own runs are shown.
+    void runDueStandingOrders(time_t now) {
+        if (now < nextStandingOrderRun) return;
+        
+        auto start = chrono::steady_clock::now();
+        int executed = 0, failed = 0;
+        nextStandingOrderRun = numeric_limits<time_t>::max();
+        ofstream log("standing_orders.log", ios::app);
+        
+        for (auto& order : standingOrders) {
+            while (order.nextRun <= now) {
+                Account* sender = findAccount(order.fromAccount);
+                Account* recipient = findAccount(order.toAccount);
+                string outcome;
+                try {
+                    if (sender == nullptr || recipient == nullptr) {
+                        throw AccountNotFoundException();
+                    }
+                    executeTransfer(*sender, *recipient, order.amount);
+                    executed++;
+                    outcome = "executed";
+                } catch (const runtime_error& e) {
+                    failed++;
+                    outcome = string("failed: ") + e.what();
+                }
+                
+                string line = "Standing order #" + to_string(order.id) + " (" + formatTimestamp(order.nextRun) + ") " + outcome;
+                log << order.fromAccount << " -> " << order.toAccount << " | " << line << "\n";
+                if (currentAccount != nullptr && currentAccount->getAccountNumber() == order.fromAccount) {
+                    cout << line << endl;
+                }
+                order.nextRun += order.intervalDays * StandingOrder::SECONDS_PER_DAY;
+            }
+            nextStandingOrderRun = min(nextStandingOrderRun, order.nextRun);
+        }
+        
+        if (executed + failed > 0) {
+            auto elapsed = chrono::steady_clock::now() - start;
+            long long micros = chrono::duration_cast<chrono::microseconds>(elapsed).count();
+            log << formatTimestamp(now) << " | scheduler run: " << executed << " executed, " 
+                << failed << " failed in " << micros << " us";
+            if (micros > 0) {
+                log << " (" << (executed + failed) * 1000000LL / micros << " runs/s)";
+            }
+            log << "\n";
+        }
+    }
+    
+    // Create, list and cancel standing orders from the current account
+    void manageStandingOrders() {
+        if (currentAccount == nullptr) return;
+        
+        const string& currency = currentAccount->getCurrency();
+        
+        cout << "\n========== STANDING ORDERS ==========\n";
+        bool any = false;
+        for (const auto& order : standingOrders) {
+            if (order.fromAccount != currentAccount->getAccountNumber()) continue;
+            if (!any) {
+                cout << left << setw(6) << "ID" << setw(10) << "To" << setw(18) << "Amount" 
+                     << setw(8) << "Every" << "Next Run\n";
+                cout << string(70, '-') << endl;
+                any = true;
+            }
+            cout << left << setw(6) << order.id
+                 << setw(10) << order.toAccount
+                 << setw(18) << formatMoney(order.amount, currency)
+                 << setw(8) << (to_string(order.intervalDays) + "d")
+                 << formatTimestamp(order.nextRun) << endl;
+        }
+        if (!any) {
+            cout << "No standing orders.\n";
+        }
+        cout << "1. Create Standing Order\n";
+        cout << "2. Cancel Standing Order\n";
+        cout << "3. Back\n";
+        cout << "Enter your choice: ";
+        
+        int choice;
+        if (!(cin >> choice)) {
+            clearInputBuffer();
+            cout << "Invalid input! Please enter a number.\n";
+            return;
+        }
+        
+        try {
+            if (choice == 1) {
+                string recipientAccNum;
+                double amount;
+                int intervalDays, startInDays;
+                
+                cout << "Enter recipient account number: ";
+                cin >> recipientAccNum;
+                Account* recipientAccount = findAccount(recipientAccNum);
+                if (recipientAccount == nullptr) {
+                    throw AccountNotFoundException();
+                }
+                if (recipientAccount->getAccountNumber() == currentAccount->getAccountNumber()) {
+                    throw SameAccountException();
+                }
+                
+                cout << "Recipient: " << recipientAccount->getAccountHolder() << endl;
+                cout << "Enter amount (" << currency << "): ";
+                if (!(cin >> amount)) {
+                    clearInputBuffer();
+                    cout << "Error: Invalid input. Please enter a valid number.\n";
+                    return;
+                }
+                cout << "Repeat every (days, up to " << StandingOrder::MAX_DAYS << "): ";
+                if (!(cin >> intervalDays)) {
+                    clearInputBuffer();
+                    cout << "Error: Invalid input. Please enter a valid number.\n";
+                    return;
+                }
+                cout << "First run in (days, 0 = now, up to " << StandingOrder::MAX_DAYS << "): ";
+                if (!(cin >> startInDays)) {
+                    clearInputBuffer();
+                    cout << "Error: Invalid input. Please enter a valid number.\n";
+                    return;
+                }
+                if (amount <= 0 || intervalDays <= 0 || intervalDays > StandingOrder::MAX_DAYS ||
+                    startInDays < 0 || startInDays > StandingOrder::MAX_DAYS) {
+                    throw InvalidAmountException();
+                }
+                
+                StandingOrder order{nextStandingOrderId++, currentAccount->getAccountNumber(),
+                                    recipientAccNum, amount, intervalDays,
+                                    time(0) + startInDays * StandingOrder::SECONDS_PER_DAY};
+                standingOrders.push_back(order);
+                nextStandingOrderRun = min(nextStandingOrderRun, order.nextRun);
+                cout << "\nStanding order #" << order.id << " created.\n";
+            } else if (choice == 2) {
+                int orderId;
+                cout << "Enter standing order ID: ";
+                if (!(cin >> orderId)) {
+                    clearInputBuffer();
+                    cout << "Error: Invalid input. Please enter a valid number.\n";
+                    return;
+                }
+                for (auto it = standingOrders.begin(); it != standingOrders.end(); ++it) {
+                    if (it->id == orderId && it->fromAccount == currentAccount->getAccountNumber()) {
+                        standingOrders.erase(it);
+                        cout << "\nStanding order #" << orderId << " cancelled.\n";
+                        return;
+                    }
+                }
+                cout << "\nError: Standing order not found\n";
+            }
+        } catch (const AccountNotFoundException& e) {
+            cout << "\nError: " << e.what() << endl;
+        } catch (const SameAccountException& e) {
+            cout << "\nError: " << e.what() << endl;
+        } catch (const InvalidAmountException& e) {
+            cout << "\nError: " << e.what() << endl;
+        }
+    }
+    
+    // Show today's, this month's and lifetime totals by transaction type
+    void viewAccountSummary() {
+        if (currentAccount == nullptr) return;
+        
+        const string& currency = currentAccount->getCurrency();
+        time_t now = time(0);
+        const string periods[] = { periodKey(now, "%Y-%m-%d"), periodKey(now, "%Y-%m"), "All" };
+        const string titles[] = { "Today", "This Month", "All Time" };
+        
+        cout << "\n========== ACCOUNT SUMMARY ==========\n";
+        for (int i = 0; i < 3; i++) {
+            cout << "\n" << titles[i] << (i < 2 ? " (" + periods[i] + ")" : "") << endl;
+            const map<string, TypeTotals>& totals = currentAccount->getTotals(periods[i]);
+            if (totals.empty()) {
+                cout << "  No transactions\n";
+                continue;
+            }
+            for (const auto& entry : totals) {
+                cout << "  " << left << setw(15) << entry.first
+                     << setw(6) << entry.second.count
+                     << formatMoney(entry.second.sum, currency) << endl;
+            }
+        }
+        cout << "=====================================\n";
+    }
+    
+    // List transfer partners, then the transfers with one of them
+    void viewTransferPartners() {
+        if (currentAccount == nullptr) return;
+        
+        const string& accNum = currentAccount->getAccountNumber();
+        auto partners = counterpartiesOf(accNum);
+        
+        cout << "\n========== TRANSFER PARTNERS ==========\n";
+        if (partners.empty()) {
+            cout << "No transfers found.\n";
+            return;
+        }
+        cout << left << setw(10) << "Account" << setw(22) << "Holder" << setw(8) << "Sent" << "Received\n";
+        cout << string(50, '-') << endl;
+        for (const auto& partner : partners) {
+            Account* acc = findAccount(partner.first);
+            cout << left << setw(10) << partner.first
+                 << setw(22) << (acc ? acc->getAccountHolder() : "")
+                 << setw(8) << partner.second->sent.size()
+                 << partner.second->received.size() << endl;
+        }
+        
+        string counterparty;
+        cout << "Enter account number to view transfers (0 to go back): ";
+        cin >> counterparty;
+        if (counterparty == "0") return;
+        
+        vector<uint64_t> ids = transfersBetween(accNum, counterparty);
+        if (ids.empty()) {
+            cout << "\nNo transfers with account " << counterparty << ".\n";
+            return;
+        }
+        cout << endl;
+        for (uint64_t id : ids) {
+            Account* owner;
+            const Transaction& trans = lookupTransaction(id, owner);
+            cout << left << setw(17) << trans.type
+                 << setw(15) << formatMoney(trans.amount, owner->getCurrency())
+                 << trans.timestamp << "  #" << trans.id << endl;
+        }
+    }
+    
+    // Pay up to 16 recipients in one all-or-nothing operation
+    void splitTransfer() {
+        if (currentAccount == nullptr) return;
+        
+        const string& currency = currentAccount->getCurrency();
+        int count;
+        
+        cout << "\n========== SPLIT TRANSFER ==========\n";
+        cout << "Available Balance: " << formatMoney(currentAccount->getAvailableBalance(), currency) << endl;
+        cout << "Number of recipients (2-16): ";
+        if (!(cin >> count) || count < 2 || count > 16) {
+            clearInputBuffer();
+            cout << "Error: Please enter a number from 2 to 16.\n";
+            return;
+        }
+        
+        try {
+            vector<pair<Account*, double>> legs;
+            for (int i = 1; i <= count; i++) {
+                string recipientAccNum;
+                double amount;
+                
+                cout << "Recipient " << i << " account number: ";
+                cin >> recipientAccNum;
+                Account* recipientAccount = findAccount(recipientAccNum);
+                if (recipientAccount == nullptr) {
+                    throw AccountNotFoundException();
+                }
+                cout << "Amount to " << recipientAccount->getAccountHolder() << " (" << currency << "): ";
+                if (!(cin >> amount)) {
+                    clearInputBuffer();
+                    cout << "Error: Invalid input. Please enter a valid number.\n";
+                    return;
+                }
+                legs.push_back(make_pair(recipientAccount, amount));
+            }
+            
+            executeSplitTransfer(*currentAccount, legs);
+            
+            cout << "\n========== SPLIT TRANSFER SUCCESSFUL ==========\n";
+            for (const auto& leg : legs) {
+                cout << formatMoney(leg.second, currency) << " to " << leg.first->getAccountHolder() << endl;
+            }
+            cout << "Your New Balance: " << formatMoney(currentAccount->getBalance(), currency) << endl;
+            cout << "===============================================\n";
+        } catch (const AccountNotFoundException& e) {
+            cout << "\nError: " << e.what() << endl;
+        } catch (const SameAccountException& e) {
+            cout << "\nError: " << e.what() << endl;
+        } catch (const InsufficientFundsException& e) {
+            cout << "\nError: " << e.what() << endl;
+        } catch (const InvalidAmountException& e) {
+            cout << "\nError: " << e.what() << endl;
+        } catch (const UnsupportedCurrencyException& e) {
+            cout << "\nError: " << e.what() << endl;
+        }
+    }
+    
+    // Balance at the end of a chosen day
+    void viewBalanceAsOf() {
+        if (currentAccount == nullptr) return;
+        
+        string input;
+        time_t dayEnd;
+        cout << "\n========== BALANCE AS OF DATE ==========\n";
+        cout << "Enter date (YYYY-MM-DD): ";
+        cin >> input;
+        if (!parseEndOfDay(input, dayEnd)) {
+            cout << "Error: Invalid date.\n";
+            return;
+        }
+        
+        double balance = currentAccount->balanceAt(dayEnd);
+        cout << "Balance at end of " << input << ": " 
+             << formatMoney(balance, currentAccount->getCurrency()) << endl;
+        cout << "========================================\n";
+    }
+    
     // Main menu
     void showMenu() {
         int choice;
         
         do {
+            runDueStandingOrders(time(0));
+            
             cout << "\n========== ATM MAIN MENU ==========\n";
             cout << "1. Balance Inquiry\n";
             cout << "2. Deposit\n";
             cout << "3. Withdrawal\n";
             cout << "4. Transfer Money\n";
             cout << "5. Transaction History\n";
-            cout << "6. Logout\n";
+            cout << "6. Card Holds\n";
+            cout << "7. Standing Orders\n";
+            cout << "8. Account Summary\n";
+            cout << "9. Transfer Partners\n";
+            cout << "10. Balance As Of Date\n";
+            cout << "11. Split Transfer\n";
+            cout << "12. Logout\n";
             cout << "===================================\n";
             cout << "Enter your choice: ";
             
@@ -346,13 +1762,335 @@ public:
                     viewTransactionHistory();
                     break;
                 case 6:
+                    manageHolds();
+                    break;
+                case 7:
+                    manageStandingOrders();
+                    break;
+                case 8:
+                    viewAccountSummary();
+                    break;
+                case 9:
+                    viewTransferPartners();
+                    break;
+                case 10:
+                    viewBalanceAsOf();
+                    break;
+                case 11:
+                    splitTransfer();
+                    break;
+                case 12:
                     cout << "\nThank you for using our ATM. Goodbye!\n";
                     currentAccount = nullptr;
+                    slowLog.flush();
+                    break;
+                default:
+                    cout << "\nInvalid choice! Please try again.\n";
+            }
+        } while (choice != 12);
+    }
+    
+    // Show the live account rankings
+    void displayLeaderboards() {
+        const size_t k = 5;
+        leaderboards.expire(time(0));
+        
+        cout << "\n========== LEADERBOARDS ==========\n";
+        cout << "Highest Balances (USD):\n";
+        for (const auto& entry : leaderboards.topBalances(k)) {
+            cout << "  " << left << setw(8) << entry.second << formatMoney(entry.first, "USD") << endl;
+        }
+        
+        cout << "Most Active (last hour):\n";
+        auto active = leaderboards.mostActive(k);
+        if (active.empty()) {
+            cout << "  No activity\n";
+        }
+        for (const auto& entry : active) {
+            cout << "  " << left << setw(8) << entry.second << entry.first << " transaction(s)\n";
+        }
+        
+        cout << "Largest Net Outflows (last hour, USD):\n";
+        bool anyOutflow = false;
+        for (const auto& entry : leaderboards.largestOutflows(k)) {
+            if (entry.first <= 0) break;
+            cout << "  " << left << setw(8) << entry.second << formatMoney(entry.first, "USD") << endl;
+            anyOutflow = true;
+        }
+        if (!anyOutflow) {
+            cout << "  No net outflows\n";
+        }
+        cout << "==================================\n";
+    }
+    
+    // Reverse a posted transaction by ID; moves money, so the operator PIN is asked again
+    void reverseTransactionScreen() {
+        string input;
+        cout << "\n========== REVERSE TRANSACTION ==========\n";
+        cout << "Enter transaction ID: ";
+        cin >> input;
+        
+        if (!authenticateOperator()) {
+            cout << "Reversal refused.\n";
+            return;
+        }
+        
+        try {
+            uint64_t id = stoull(input);
+            reverseTransaction(id);
+            cout << "\nTransaction #" << id << " reversed.\n";
+        } catch (const invalid_argument&) {
+            cout << "Error: Invalid input. Please enter a valid number.\n";
+        } catch (const out_of_range&) {
+            cout << "Error: Invalid input. Please enter a valid number.\n";
+        } catch (const TransactionNotFoundException& e) {
+            cout << "\nError: " << e.what() << endl;
+        } catch (const ReversalNotAllowedException& e) {
+            cout << "\nError: " << e.what() << endl;
+        } catch (const InsufficientFundsException& e) {
+            cout << "\nError: " << e.what() << endl;
+        }
+    }
+    
+    // Look for money moving in circles and accounts that both collect and spread funds
+    void analyzeTransferGraph() {
+        vector<string> nodeNames;
+        map<string, size_t> nodeIndex;
+        for (const auto& acc : accounts) {
+            nodeIndex[acc.getAccountNumber()] = nodeNames.size();
+            nodeNames.push_back(acc.getAccountNumber());
+        }
+        
+        vector<pair<size_t, size_t>> edges;
+        for (size_t i = 0; i < nodeNames.size(); i++) {
+            for (const auto& partner : counterpartiesOf(nodeNames[i])) {
+                if (!partner.second->sent.empty()) {
+                    edges.push_back(make_pair(i, nodeIndex[partner.first]));
+                }
+            }
+        }
+        TransferGraph graph(nodeNames, edges);
+        
+        cout << "\n========== FRAUD RING ANALYSIS ==========\n";
+        cout << graph.nodeCount() << " accounts, " << graph.edgeCount() << " transfer links\n";
+        
+        cout << "\nConnected Groups:\n";
+        auto groups = graph.components();
+        if (groups.empty()) cout << "  None\n";
+        for (const auto& group : groups) {
+            cout << " ";
+            for (const auto& accNum : group) cout << " " << accNum;
+            cout << endl;
+        }
+        
+        cout << "\nTransfer Cycles (up to 4 accounts):\n";
+        auto cycles = graph.cycles(4);
+        if (cycles.empty()) cout << "  None\n";
+        for (const auto& cycle : cycles) {
+            cout << " ";
+            for (const auto& accNum : cycle) cout << " " << accNum << " ->";
+            cout << " " << cycle.front() << endl;
+        }
+        
+        // Mule accounts receive from many and pay out to many
+        cout << "\nFan-in / Fan-out:\n";
+        cout << "  " << left << setw(10) << "Account" << setw(8) << "In" << setw(8) << "Out" << "Score\n";
+        bool any = false;
+        for (size_t i = 0; i < graph.nodeCount(); i++) {
+            if (graph.inDegree(i) == 0 && graph.outDegree(i) == 0) continue;
+            cout << "  " << left << setw(10) << graph.node(i)
+                 << setw(8) << graph.inDegree(i)
+                 << setw(8) << graph.outDegree(i)
+                 << graph.inDegree(i) * graph.outDegree(i) << endl;
+            any = true;
+        }
+        if (!any) cout << "  No transfers\n";
+        cout << "=========================================\n";
+    }
+    
+    // As-of balances of every account at the end of a month
+    void displayMonthEndBalances() {
+        string input;
+        int year, month;
+        char extra;
+        cout << "\n========== MONTH-END BALANCES ==========\n";
+        cout << "Enter month (YYYY-MM): ";
+        cin >> input;
+        if (sscanf(input.c_str(), "%d-%d%c", &year, &month, &extra) != 2 || month < 1 || month > 12) {
+            cout << "Error: Invalid month.\n";
+            return;
+        }
+        
+        time_t monthEnd = endOfDay(year, month + 1, 0);
+        double totalUsd = 0.0;
+        cout << left << setw(10) << "Account" << setw(22) << "Holder" << "Balance\n";
+        cout << string(50, '-') << endl;
+        for (const auto& acc : accounts) {
+            double balance = acc.balanceAt(monthEnd);
+            totalUsd += rates.convert(balance, acc.getCurrency(), "USD");
+            cout << left << setw(10) << acc.getAccountNumber()
+                 << setw(22) << acc.getAccountHolder()
+                 << formatMoney(balance, acc.getCurrency()) << endl;
+        }
+        cout << string(50, '-') << endl;
+        cout << "Total (USD): " << formatMoney(totalUsd, "USD") << endl;
+        cout << "As of: " << formatTimestamp(monthEnd) << endl;
+        cout << "========================================\n";
+    }
+    
+    // Net the day's interbank obligations into one position per bank and post them
+    void runSettlement() {
+        set<string> banks;
+        for (const auto& acc : accounts) {
+            banks.insert(acc.getBank());
+        }
+        
+        cout << "\n========== END-OF-DAY SETTLEMENT ==========\n";
+        if (interbankObligations.empty()) {
+            cout << "No interbank transfers to settle.\n";
+            if (!settlements.empty()) {
+                time_t last = settlements.back().time;
+                cout << "\nLast settlement (" << formatTimestamp(last) << "):\n";
+                for (const auto& entry : settlements) {
+                    if (entry.time != last) continue;
+                    cout << "  " << left << setw(14) << entry.bank 
+                         << formatMoney(fabs(entry.netPosition), "USD")
+                         << (entry.netPosition < 0 ? "  paid" : entry.netPosition > 0 ? "  received" : "") << endl;
+                }
+            }
+            cout << "===========================================\n";
+            return;
+        }
+        
+        // Gross obligations, payer banks down the side and payee banks across (USD)
+        cout << left << setw(12) << "Owes \\ To";
+        for (const auto& bank : banks) cout << setw(14) << bank;
+        cout << endl;
+        
+        map<string, double> net;
+        for (const auto& payer : banks) {
+            cout << left << setw(12) << payer;
+            for (const auto& payee : banks) {
+                auto it = interbankObligations.find(make_pair(payer, payee));
+                double owed = (it == interbankObligations.end()) ? 0.0 : it->second;
+                cout << setw(14) << formatMoney(owed, "USD");
+                net[payer] -= owed;
+                net[payee] += owed;
+            }
+            cout << endl;
+        }
+        
+        cout << "\nNet Positions (USD):\n";
+        time_t now = time(0);
+        for (const auto& bank : banks) {
+            cout << "  " << left << setw(14) << bank << formatMoney(fabs(net[bank]), "USD")
+                 << (net[bank] < 0 ? "  pays" : net[bank] > 0 ? "  receives" : "") << endl;
+            settlements.push_back(SettlementEntry{now, bank, net[bank]});
+        }
+        interbankObligations.clear();
+        
+        cout << "\nSettlement posted at " << formatTimestamp(now) << ".\n";
+        cout << "===========================================\n";
+    }
+    
+    // Debit and credit totals of every ledger account; the two columns must agree
+    void displayTrialBalance() {
+        auto totals = journal.trialBalance();
+        double totalDebits = 0.0, totalCredits = 0.0;
+        
+        cout << "\n========== TRIAL BALANCE (USD) ==========\n";
+        cout << left << setw(20) << "Ledger" << setw(18) << "Debits" << setw(18) << "Credits" << "Balance\n";
+        cout << string(72, '-') << endl;
+        for (const auto& ledger : totals) {
+            double debits = ledger.second.first, credits = ledger.second.second;
+            totalDebits += debits;
+            totalCredits += credits;
+            cout << left << setw(20) << ledger.first
+                 << setw(18) << formatMoney(debits, "USD")
+                 << setw(18) << formatMoney(credits, "USD")
+                 << formatMoney(fabs(debits - credits), "USD") 
+                 << (debits > credits + 0.005 ? " Dr" : credits > debits + 0.005 ? " Cr" : "") << endl;
+        }
+        cout << string(72, '-') << endl;
+        cout << left << setw(20) << "Total"
+             << setw(18) << formatMoney(totalDebits, "USD")
+             << setw(18) << formatMoney(totalCredits, "USD") << endl;
+        cout << journal.size() << " journal legs, "
+             << (fabs(totalDebits - totalCredits) < 0.005 ? "in balance" : "OUT OF BALANCE") << endl;
+        cout << "=========================================\n";
+    }
+    
+    // Operator authentication against ATM_OPERATOR_PIN
+    bool authenticateOperator() {
+        if (operatorPin.empty()) {
+            cout << "\nOperations menu is disabled (ATM_OPERATOR_PIN not set).\n";
+            return false;
+        }
+        
+        string pin;
+        cout << "Enter Operator PIN: ";
+        cin >> pin;
+        
+        try {
+            if (pin != operatorPin) {
+                throw AuthenticationException();
+            }
+            return true;
+        } catch (const AuthenticationException& e) {
+            cout << "\nError: " << e.what() << endl;
+            return false;
+        }
+    }
+    
+    // Operator reports, reached from the login prompt; requires the operator PIN
+    void showOperationsMenu() {
+        if (!authenticateOperator()) return;
+        
+        int choice;
+        
+        do {
+            cout << "\n========== OPERATIONS MENU ==========\n";
+            cout << "1. Leaderboards\n";
+            cout << "2. Reverse Transaction\n";
+            cout << "3. Fraud Ring Analysis\n";
+            cout << "4. Month-End Balances\n";
+            cout << "5. End-of-Day Settlement\n";
+            cout << "6. Trial Balance\n";
+            cout << "7. Back\n";
+            cout << "=====================================\n";
+            cout << "Enter your choice: ";
+            
+            if (!(cin >> choice)) {
+                clearInputBuffer();
+                cout << "Invalid input! Please enter a number.\n";
+                continue;
+            }
+            
+            switch (choice) {
+                case 1:
+                    displayLeaderboards();
+                    break;
+                case 2:
+                    reverseTransactionScreen();
+                    break;
+                case 3:
+                    analyzeTransferGraph();
+                    break;
+                case 4:
+                    displayMonthEndBalances();
+                    break;
+                case 5:
+                    runSettlement();
+                    break;
+                case 6:
+                    displayTrialBalance();
+                    break;
+                case 7:
                     break;
                 default:
                     cout << "\nInvalid choice! Please try again.\n";
             }
-        } while (choice != 6);
+        } while (choice != 7);
     }
     
     // Display test accounts
@@ -380,13 +2118,22 @@ int main() {
         }
         
         char choice;
-        cout << "\nDo you want to login with another account? (y/n): ";
-        cin >> choice;
+        do {
+            cout << "\nDo you want to login with another account? (y/n, o = operations): ";
+            cin >> choice;
+            if (choice == 'o' || choice == 'O') {
+                atm.showOperationsMenu();
+            }
+        } while (choice == 'o' || choice == 'O');
         if (choice != 'y' && choice != 'Y') {
             cout << "\nThank you for using our ATM system!\n";
             break;
         }
     }
     
+#ifdef ATM_PROFILE
+    PhaseProfiler::instance().report();
+#endif
+    
     return 0;
 }
\ No newline at end of file